@@ -3,6 +3,9 @@
 #include <thread>
 #include <mutex>
 #include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <string>
 #include <windows.h>
 
 // Константы игры
@@ -13,8 +16,48 @@ const char EMPTY = '.',                // Пустая клетка
             WHITE_KING = 'w',         // Белая дамка
             BLACK_KING = 'b';         // Черная дамка
 
+// Правила ничьей
+const int REPETITION_LIMIT = 3;        // Троекратное повторение позиции
+const int NO_PROGRESS_LIMIT = 80;      // 40 ходов каждой стороны (полуходов) без взятий
+                                       // и ходов простыми шашками
+
 std::mutex mtx;  // Мьютекс для синхронизации потоков
 
+// Индекс фигуры в таблице ключей хеширования (-1 для пустой клетки)
+int pieceIndex(char piece) {
+    switch (piece) {
+        case WHITE: return 0;
+        case BLACK: return 1;
+        case WHITE_KING: return 2;
+        case BLACK_KING: return 3;
+        default: return -1;
+    }
+}
+
+// Случайные ключи для хеширования позиций
+struct HashKeys {
+    uint64_t squares[BOARD_SIZE][BOARD_SIZE][4];  // Ключ для фигуры на клетке
+    uint64_t blackToMove;                         // Ключ очереди хода черных
+
+    HashKeys() {
+        // Детерминированный генератор splitmix64
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (int i = 0; i < BOARD_SIZE; ++i)
+            for (int j = 0; j < BOARD_SIZE; ++j)
+                for (int k = 0; k < 4; ++k)
+                    squares[i][j][k] = next();
+        blackToMove = next();
+    }
+};
+
+const HashKeys hashKeys;
+
 // Структура для хранения координат хода
 struct Move {
     int startRow, startCol;  // Начальная позиция
@@ -61,6 +104,18 @@ public:
         }
     }
 
+    // Хеш позиции с учетом очереди хода (вычисляется заново по всем клеткам)
+    uint64_t hash(char sideToMove) const {
+        uint64_t h = (sideToMove == BLACK) ? hashKeys.blackToMove : 0;
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                int k = pieceIndex(board[i][j]);
+                if (k >= 0) h ^= hashKeys.squares[i][j][k];
+            }
+        }
+        return h;
+    }
+
     // Проверка валидности хода
     bool isMoveValid(Move move, char player) {
         // Проверка границ доски
@@ -82,10 +137,23 @@ public:
         int rowDiff = abs(move.endRow - move.startRow);
         int colDiff = abs(move.endCol - move.startCol);
 
+        char opponent = (player == WHITE) ? BLACK : WHITE;
+
         // Проверка ходов для дамок
         if (current == WHITE_KING || current == BLACK_KING) {
             // Дамки могут ходить на любое расстояние по диагонали
-            return rowDiff == colDiff;
+            if (rowDiff != colDiff) return false;
+            // Путь должен быть свободен, кроме взятия через одну клетку
+            int dr = (move.endRow > move.startRow) ? 1 : -1;
+            int dc = (move.endCol > move.startCol) ? 1 : -1;
+            for (int k = 1; k < rowDiff; ++k) {
+                char cell = board[move.startRow + k*dr][move.startCol + k*dc];
+                if (cell == EMPTY) continue;
+                if (rowDiff == 2 && (cell == opponent || cell == tolower(opponent)))
+                    continue;
+                return false;
+            }
+            return true;
         }
 
         // Обычные ходы (без взятия)
@@ -101,7 +169,6 @@ public:
         if (rowDiff == 2 && colDiff == 2) {
             int midRow = (move.startRow + move.endRow) / 2;
             int midCol = (move.startCol + move.endCol) / 2;
-            char opponent = (player == WHITE) ? BLACK : WHITE;
 
             // Проверка наличия вражеской шашки для взятия
             return (board[midRow][midCol] == opponent ||
@@ -111,6 +178,19 @@ public:
         return false;
     }
 
+    // Ход со взятием: прыжок на 2 клетки через шашку противника
+    bool isCaptureMove(Move move, char player) {
+        if (abs(move.endRow - move.startRow) != 2 ||
+            abs(move.endCol - move.startCol) != 2 ||
+            !isMoveValid(move, player))
+            return false;
+        int midRow = (move.startRow + move.endRow) / 2;
+        int midCol = (move.startCol + move.endCol) / 2;
+        char opponent = (player == WHITE) ? BLACK : WHITE;
+        return board[midRow][midCol] == opponent ||
+               board[midRow][midCol] == tolower(opponent);
+    }
+
     // Выполнение хода на доске
     void makeMove(Move move, char player) {
         // Перемещение шашки
@@ -150,25 +230,92 @@ public:
         return false;
     }
 
+    // Проверка наличия взятий у шашки на заданной клетке
+    bool hasCaptureFrom(char player, int row, int col) {
+        for (int di = -2; di <= 2; di += 4) {
+            for (int dj = -2; dj <= 2; dj += 4) {
+                Move move = {row, col, row+di, col+dj};
+                if (isCaptureMove(move, player)) return true;
+            }
+        }
+        return false;
+    }
+
     // Проверка наличия обязательных взятий
     bool hasCaptureMoves(char player) {
         for (int i = 0; i < BOARD_SIZE; ++i) {
             for (int j = 0; j < BOARD_SIZE; ++j) {
-                if (board[i][j] == player || board[i][j] == tolower(player)) {
-                    // Проверка только ходов со взятием (на 2 клетки)
-                    for (int di = -2; di <= 2; di += 4) {
-                        for (int dj = -2; dj <= 2; dj += 4) {
-                            Move move = {i, j, i+di, j+dj};
-                            if (isMoveValid(move, player)) return true;
-                        }
-                    }
-                }
+                if ((board[i][j] == player || board[i][j] == tolower(player)) &&
+                    hasCaptureFrom(player, i, j))
+                    return true;
             }
         }
         return false;
     }
 };
 
+// Ход необратим, если было взятие или ходила простая шашка
+bool isIrreversibleChange(const Board& before, const Board& after) {
+    int piecesBefore = 0, piecesAfter = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            char b = before.board[i][j], a = after.board[i][j];
+            if (b != EMPTY) ++piecesBefore;
+            if (a != EMPTY) ++piecesAfter;
+            if (b != a && (b == WHITE || b == BLACK || a == WHITE || a == BLACK))
+                return true;
+        }
+    }
+    return piecesBefore != piecesAfter;
+}
+
+// История партии: хеши позиций после каждого полухода
+class GameHistory {
+public:
+    // Начало партии с заданной позиции
+    void reset(uint64_t hash) {
+        hashes.assign(1, hash);
+        lastIrreversible = 0;
+    }
+
+    // Добавление позиции после очередного полухода
+    void push(uint64_t hash, bool irreversible) {
+        hashes.push_back(hash);
+        if (irreversible) lastIrreversible = hashes.size() - 1;
+    }
+
+    // Сколько раз позиция встречалась раньше, если она стоит (или встанет)
+    // на полуходе ply. Просматриваются только позиции с тем же игроком
+    // на ходу и только после последнего необратимого хода.
+    int countRepetitions(uint64_t hash, size_t ply) const {
+        int count = 0;
+        for (size_t back = 2; back <= ply - lastIrreversible; back += 2) {
+            if (hashes[ply - back] == hash) ++count;
+        }
+        return count;
+    }
+
+    // Приведет ли новая позиция к повторению
+    bool wouldRepeat(uint64_t hash) const {
+        return countRepetitions(hash, hashes.size()) > 0;
+    }
+
+    // Троекратное повторение текущей позиции
+    bool isThreefoldRepetition() const {
+        size_t ply = hashes.size() - 1;
+        return countRepetitions(hashes[ply], ply) + 1 >= REPETITION_LIMIT;
+    }
+
+    // Превышен лимит ходов без взятий и ходов простыми шашками
+    bool isNoProgressLimit() const {
+        return hashes.size() - 1 - lastIrreversible >= NO_PROGRESS_LIMIT;
+    }
+
+private:
+    std::vector<uint64_t> hashes;  // Хеши позиций по полуходам
+    size_t lastIrreversible = 0;   // Полуход последнего необратимого хода
+};
+
 // Рекурсивная функция для выполнения серии взятий
 bool tryCapture(Board& board, char player, int startRow, int startCol) {
     bool moveMade = false;
@@ -177,12 +324,12 @@ bool tryCapture(Board& board, char player, int startRow, int startCol) {
         for (int dj = -2; dj <= 2; dj += 4) {
             int ni = startRow + di, nj = startCol + dj;
             Move move = {startRow, startCol, ni, nj};
-            if (board.isMoveValid(move, player)) {
+            if (board.isCaptureMove(move, player)) {
                 board.makeMove(move, player);
                 moveMade = true;
-                // Рекурсивная проверка следующих взятий
-                if (board.hasCaptureMoves(player)) {
-                    moveMade = tryCapture(board, player, ni, nj);
+                // Рекурсивная проверка следующих взятий той же шашкой
+                if (board.hasCaptureFrom(player, ni, nj)) {
+                    tryCapture(board, player, ni, nj);
                 }
                 break;
             }
@@ -193,16 +340,16 @@ bool tryCapture(Board& board, char player, int startRow, int startCol) {
 }
 
 // Параллельная версия функции для обработки взятий
+// (вызывается под мьютексом mtx, который захватывает поток)
 void tryCaptureParallel(Board& board, char player, int startRow, int startCol, bool& moveMade) {
     for (int di = -2; di <= 2; di += 4) {
         for (int dj = -2; dj <= 2; dj += 4) {
             Move move = {startRow, startCol, startRow+di, startCol+dj};
-            if (board.isMoveValid(move, player)) {
-                std::lock_guard<std::mutex> lock(mtx);  // Захват мьютекса
+            if (board.isCaptureMove(move, player)) {
                 board.makeMove(move, player);
                 moveMade = true;
-                // Рекурсивная проверка следующих взятий
-                if (board.hasCaptureMoves(player)) {
+                // Рекурсивная проверка следующих взятий той же шашкой
+                if (board.hasCaptureFrom(player, move.endRow, move.endCol)) {
                     bool nextMove = false;
                     tryCaptureParallel(board, player, move.endRow, move.endCol, nextMove);
                     moveMade |= nextMove;
@@ -238,7 +385,7 @@ void playerMove(Board& board, char player) {
         if (board.isMoveValid(move, player)) {
             if (hasCapture) {
                 // Проверка выполнения обязательного взятия
-                if (abs(move.startRow - move.endRow) == 2) {
+                if (board.isCaptureMove(move, player)) {
                     board.makeMove(move, player);
                     break;
                 } else {
@@ -255,25 +402,36 @@ void playerMove(Board& board, char player) {
 }
 
 // Обработка хода компьютера
-void aiMove(Board& board, char aiPlayer) {
+void aiMove(Board& board, char aiPlayer, const GameHistory& history) {
     bool moveMade = false;
 
     // Сначала проверяем обязательные взятия
     if (board.hasCaptureMoves(aiPlayer)) {
-        std::vector<std::thread> threads;
-        // Параллельный поиск возможных взятий
-        for (int i = 0; i < BOARD_SIZE && !moveMade; ++i) {
-            for (int j = 0; j < BOARD_SIZE && !moveMade; ++j) {
-                if (board.board[i][j] == aiPlayer ||
-                    board.board[i][j] == tolower(aiPlayer)) {
-                    threads.emplace_back([&, i, j]() {
-                        bool localMove = false;
-                        tryCaptureParallel(board, aiPlayer, i, j, localMove);
-                        if (localMove) moveMade = true;
-                    });
+        // Шашки, которые могут бить (собираются до запуска потоков)
+        std::vector<std::pair<int, int>> capturers;
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                if ((board.board[i][j] == aiPlayer ||
+                     board.board[i][j] == tolower(aiPlayer)) &&
+                    board.hasCaptureFrom(aiPlayer, i, j)) {
+                    capturers.emplace_back(i, j);
                 }
             }
         }
+
+        std::vector<std::thread> threads;
+        // Параллельный поиск возможных взятий
+        for (const auto& cell : capturers) {
+            int i = cell.first, j = cell.second;
+            threads.emplace_back([&, i, j]() {
+                // Только один поток выполняет серию взятий за ход
+                std::lock_guard<std::mutex> lock(mtx);
+                if (moveMade) return;
+                bool localMove = false;
+                tryCaptureParallel(board, aiPlayer, i, j, localMove);
+                if (localMove) moveMade = true;
+            });
+        }
         // Ожидание завершения всех потоков
         for (auto& t : threads) {
             if (t.joinable()) t.join();
@@ -282,6 +440,9 @@ void aiMove(Board& board, char aiPlayer) {
 
     // Если взятий нет - делаем обычный ход
     if (!moveMade) {
+        char opponent = (aiPlayer == WHITE) ? BLACK : WHITE;
+        bool hasFallback = false;
+        Move fallback = {};  // Ход, повторяющий позицию
         for (int i = 0; i < BOARD_SIZE && !moveMade; ++i) {
             for (int j = 0; j < BOARD_SIZE && !moveMade; ++j) {
                 if (board.board[i][j] == aiPlayer ||
@@ -291,6 +452,16 @@ void aiMove(Board& board, char aiPlayer) {
                         for (int dj = -2; dj <= 2; ++dj) {
                             Move move = {i, j, i+di, j+dj};
                             if (board.isMoveValid(move, aiPlayer)) {
+                                // Избегаем повторения позиции, если есть другой ход
+                                Board next = board;
+                                next.makeMove(move, aiPlayer);
+                                if (history.wouldRepeat(next.hash(opponent))) {
+                                    if (!hasFallback) {
+                                        fallback = move;
+                                        hasFallback = true;
+                                    }
+                                    continue;
+                                }
                                 board.makeMove(move, aiPlayer);
                                 moveMade = true;
                                 break;
@@ -301,6 +472,9 @@ void aiMove(Board& board, char aiPlayer) {
                 }
             }
         }
+        if (!moveMade && hasFallback) {
+            board.makeMove(fallback, aiPlayer);
+        }
     }
 
     // Искусственная задержка для реалистичности
@@ -319,11 +493,30 @@ int main() {
     playerColor = toupper(playerColor);
     aiColor = (playerColor == WHITE) ? BLACK : WHITE;
 
+    // История позиций для определения ничьей (первыми ходят белые)
+    GameHistory history;
+    history.reset(board.hash(WHITE));
+
+    // Проверка ничьей после очередного полухода
+    auto isDraw = [&history]() {
+        if (history.isThreefoldRepetition()) {
+            std::cout << "Позиция повторилась трижды. Ничья!\n";
+            return true;
+        }
+        if (history.isNoProgressLimit()) {
+            std::cout << "40 ходов без взятий и ходов простыми шашками. Ничья!\n";
+            return true;
+        }
+        return false;
+    };
+
     // Первый ход черных (если игрок выбрал белых)
     if (playerColor == WHITE) {
         board.display();
     } else {
-        aiMove(board, aiColor);
+        Board before = board;
+        aiMove(board, aiColor, history);
+        history.push(board.hash(playerColor), isIrreversibleChange(before, board));
         board.display();
     }
 
@@ -334,16 +527,22 @@ int main() {
             std::cout << "Нет возможных ходов. Вы проиграли!\n";
             break;
         }
+        Board before = board;
         playerMove(board, playerColor);
+        history.push(board.hash(aiColor), isIrreversibleChange(before, board));
         board.display();
+        if (isDraw()) break;
 
         // Ход компьютера
         if (!board.hasPossibleMoves(aiColor)) {
             std::cout << "У компьютера нет ходов. Вы победили!\n";
             break;
         }
-        aiMove(board, aiColor);
+        before = board;
+        aiMove(board, aiColor, history);
+        history.push(board.hash(playerColor), isIrreversibleChange(before, board));
         board.display();
+        if (isDraw()) break;
     }
 
     return 0;
@@ -3,13 +3,52 @@
 #include <thread>
 #include <mutex>
 #include <algorithm>
+#include <cstdint>
+#include <string>
 #include <windows.h>
 
 const int BOARD_SIZE = 8;
 const char EMPTY = '.', WHITE = 'W', BLACK = 'B', WHITE_KING = 'w', BLACK_KING = 'b';
 
+// Ничья: троекратное повторение или 40 ходов каждой стороны (80 полуходов)
+// без взятий и ходов простыми шашками
+const int REPETITION_LIMIT = 3, NO_PROGRESS_LIMIT = 80;
+
 std::mutex mtx;
 
+int pieceIndex(char piece) {
+    switch (piece) {
+        case WHITE: return 0;
+        case BLACK: return 1;
+        case WHITE_KING: return 2;
+        case BLACK_KING: return 3;
+        default: return -1;
+    }
+}
+
+// Случайные ключи для хеширования позиций
+struct HashKeys {
+    uint64_t squares[BOARD_SIZE][BOARD_SIZE][4];
+    uint64_t blackToMove;
+
+    HashKeys() {
+        uint64_t state = 0x9E3779B97F4A7C15ULL; // splitmix64
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (int i = 0; i < BOARD_SIZE; ++i)
+            for (int j = 0; j < BOARD_SIZE; ++j)
+                for (int k = 0; k < 4; ++k)
+                    squares[i][j][k] = next();
+        blackToMove = next();
+    }
+};
+
+const HashKeys hashKeys;
+
 struct Move {
     int startRow, startCol, endRow, endCol;
 };
@@ -56,6 +95,18 @@ public:
         }
     }
 
+    // Хеш позиции с учетом очереди хода (вычисляется заново по всем клеткам)
+    uint64_t hash(char sideToMove) const {
+        uint64_t h = (sideToMove == BLACK) ? hashKeys.blackToMove : 0;
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                int k = pieceIndex(board[i][j]);
+                if (k >= 0) h ^= hashKeys.squares[i][j][k];
+            }
+        }
+        return h;
+    }
+
     bool isMoveValid(Move move, char player) {
         if (move.startRow < 0 || move.startRow >= BOARD_SIZE || move.startCol < 0 || move.startCol >= BOARD_SIZE ||
             move.endRow < 0 || move.endRow >= BOARD_SIZE || move.endCol < 0 || move.endCol >= BOARD_SIZE)
@@ -72,12 +123,23 @@ public:
 
         int rowDiff = std::abs(move.endRow - move.startRow);
         int colDiff = std::abs(move.endCol - move.startCol);
+        char opponent = (player == WHITE) ? BLACK : WHITE;
 
         // Если это дамка, она может двигаться на любое количество клеток по диагонали
         if (board[move.startRow][move.startCol] == WHITE_KING || board[move.startRow][move.startCol] == BLACK_KING) {
-            if (rowDiff == colDiff) {
-                return true; // Дамка может двигаться по диагонали
+            if (rowDiff != colDiff) {
+                return false;
+            }
+            // Путь должен быть свободен, кроме рубки через одну клетку
+            int dr = (move.endRow > move.startRow) ? 1 : -1;
+            int dc = (move.endCol > move.startCol) ? 1 : -1;
+            for (int k = 1; k < rowDiff; ++k) {
+                char cell = board[move.startRow + k * dr][move.startCol + k * dc];
+                if (cell == EMPTY) continue;
+                if (rowDiff == 2 && (cell == opponent || cell == tolower(opponent))) continue;
+                return false;
             }
+            return true;
         }
 
         // Обычные ходы (по диагонали на одну клетку)
@@ -92,7 +154,6 @@ public:
         if (rowDiff == 2 && colDiff == 2) {
             int midRow = (move.startRow + move.endRow) / 2;
             int midCol = (move.startCol + move.endCol) / 2;
-            char opponent = (player == WHITE) ? BLACK : WHITE;
 
             if (board[midRow][midCol] == opponent || board[midRow][midCol] == tolower(opponent)) {
                 return true; // Рубка возможна
@@ -102,8 +163,19 @@ public:
         return false;
     }
 
+    // Рубящий ход: прыжок на две клетки через шашку противника
+    bool isCaptureMove(Move move, char player) {
+        if (std::abs(move.endRow - move.startRow) != 2 || std::abs(move.endCol - move.startCol) != 2 ||
+            !isMoveValid(move, player))
+            return false;
+        int midRow = (move.startRow + move.endRow) / 2;
+        int midCol = (move.startCol + move.endCol) / 2;
+        char opponent = (player == WHITE) ? BLACK : WHITE;
+        return board[midRow][midCol] == opponent || board[midRow][midCol] == tolower(opponent);
+    }
+
     void makeMove(Move move, char player) {
-        board[move.endRow][move.endCol] = player;
+        board[move.endRow][move.endCol] = board[move.startRow][move.startCol];
         board[move.startRow][move.startCol] = EMPTY;
 
         // Если шашка достигла последней линии, превращаем в дамку
@@ -138,18 +210,22 @@ public:
         return false;
     }
 
+    bool hasCaptureFrom(char player, int row, int col) {
+        for (int di = -2; di <= 2; di += 4) {
+            for (int dj = -2; dj <= 2; dj += 4) {
+                if (isCaptureMove({row, col, row + di, col + dj}, player)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     bool hasCaptureMoves(char player) {
         for (int i = 0; i < BOARD_SIZE; ++i) {
             for (int j = 0; j < BOARD_SIZE; ++j) {
-                if (board[i][j] == player || board[i][j] == tolower(player)) {
-                    for (int di = -2; di <= 2; di += 4) {
-                        for (int dj = -2; dj <= 2; dj += 4) {
-                            int ni = i + di, nj = j + dj;
-                            if (isMoveValid({i, j, ni, nj}, player)) {
-                                return true; // Если найден хотя бы один рубящий ход
-                            }
-                        }
-                    }
+                if ((board[i][j] == player || board[i][j] == tolower(player)) && hasCaptureFrom(player, i, j)) {
+                    return true; // Если найден хотя бы один рубящий ход
                 }
             }
         }
@@ -158,18 +234,74 @@ public:
 
 };
 
+// Ход необратим, если была рубка или ходила простая шашка
+bool isIrreversibleChange(const Board& before, const Board& after) {
+    int piecesBefore = 0, piecesAfter = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            char b = before.board[i][j], a = after.board[i][j];
+            if (b != EMPTY) ++piecesBefore;
+            if (a != EMPTY) ++piecesAfter;
+            if (b != a && (b == WHITE || b == BLACK || a == WHITE || a == BLACK))
+                return true;
+        }
+    }
+    return piecesBefore != piecesAfter;
+}
+
+// История партии: хеши позиций после каждого полухода
+class GameHistory {
+public:
+    void reset(uint64_t hash) {
+        hashes.assign(1, hash);
+        lastIrreversible = 0;
+    }
+
+    void push(uint64_t hash, bool irreversible) {
+        hashes.push_back(hash);
+        if (irreversible) lastIrreversible = hashes.size() - 1;
+    }
+
+    // Сколько раз позиция на полуходе ply встречалась раньше. Просматриваются
+    // только позиции с тем же игроком на ходу после последнего необратимого хода.
+    int countRepetitions(uint64_t hash, size_t ply) const {
+        int count = 0;
+        for (size_t back = 2; back <= ply - lastIrreversible; back += 2) {
+            if (hashes[ply - back] == hash) ++count;
+        }
+        return count;
+    }
+
+    bool wouldRepeat(uint64_t hash) const {
+        return countRepetitions(hash, hashes.size()) > 0;
+    }
+
+    bool isThreefoldRepetition() const {
+        size_t ply = hashes.size() - 1;
+        return countRepetitions(hashes[ply], ply) + 1 >= REPETITION_LIMIT;
+    }
+
+    bool isNoProgressLimit() const {
+        return hashes.size() - 1 - lastIrreversible >= NO_PROGRESS_LIMIT;
+    }
+
+private:
+    std::vector<uint64_t> hashes;
+    size_t lastIrreversible = 0;
+};
+
 // Функция для совершения нескольких рубок подряд
 bool tryCapture(Board& board, char player, int startRow, int startCol) {
     bool moveMade = false;
     for (int di = -2; di <= 2; di += 4) {
         for (int dj = -2; dj <= 2; dj += 4) {
             int ni = startRow + di, nj = startCol + dj;
-            if (board.isMoveValid({startRow, startCol, ni, nj}, player)) {
+            if (board.isCaptureMove({startRow, startCol, ni, nj}, player)) {
                 board.makeMove({startRow, startCol, ni, nj}, player);
                 moveMade = true;
-                // После рубки проверим, можно ли продолжить рубить
-                if (board.hasCaptureMoves(player)) {
-                    moveMade = tryCapture(board, player, ni, nj); // Рубим подряд
+                // После рубки проверим, может ли та же шашка продолжить рубить
+                if (board.hasCaptureFrom(player, ni, nj)) {
+                    tryCapture(board, player, ni, nj); // Рубим подряд
                 }
                 break;
             }
@@ -202,12 +334,7 @@ void playerMove(Board& board, char player) {
         if (board.isMoveValid(move, player)) {
             if (hasCapture) {
                 // Проверяем, является ли текущий ход рубящим
-                int midRow = (move.startRow + move.endRow) / 2;
-                int midCol = (move.startCol + move.endCol) / 2;
-                char opponent = (player == WHITE) ? BLACK : WHITE;
-
-                if (std::abs(move.startRow - move.endRow) == 2 &&
-                    board.board[midRow][midCol] == opponent) {
+                if (board.isCaptureMove(move, player)) {
                     board.makeMove(move, player);
                     break; // Завершаем ход, если рубка выполнена
                 } else {
@@ -223,14 +350,14 @@ void playerMove(Board& board, char player) {
     }
 }
 
-void aiMove(Board& board, char aiPlayer) {
+void aiMove(Board& board, char aiPlayer, const GameHistory& history) {
     bool moveMade = false;
 
     // Проверяем, есть ли у AI рубка
     if (board.hasCaptureMoves(aiPlayer)) {
         for (int i = 0; i < BOARD_SIZE && !moveMade; ++i) {
             for (int j = 0; j < BOARD_SIZE && !moveMade; ++j) {
-                if (board.board[i][j] == aiPlayer) {
+                if (board.board[i][j] == aiPlayer || board.board[i][j] == tolower(aiPlayer)) {
                     moveMade = tryCapture(board, aiPlayer, i, j); // Рубим подряд
                 }
             }
@@ -238,14 +365,26 @@ void aiMove(Board& board, char aiPlayer) {
     }
 
     if (!moveMade) {
-        // Если нет рубки, ищем обычный ход
+        // Если нет рубки, ищем обычный ход, не повторяющий позицию
+        char opponent = (aiPlayer == WHITE) ? BLACK : WHITE;
+        bool hasFallback = false;
+        Move fallback = {};
         for (int i = 0; i < BOARD_SIZE && !moveMade; ++i) {
             for (int j = 0; j < BOARD_SIZE && !moveMade; ++j) {
-                if (board.board[i][j] == aiPlayer) {
-                    for (int di = -2; di <= 2; ++di) {
+                if (board.board[i][j] == aiPlayer || board.board[i][j] == tolower(aiPlayer)) {
+                    for (int di = -2; di <= 2 && !moveMade; ++di) {
                         for (int dj = -2; dj <= 2; ++dj) {
                             int ni = i + di, nj = j + dj;
                             if (board.isMoveValid({i, j, ni, nj}, aiPlayer)) {
+                                Board next = board;
+                                next.makeMove({i, j, ni, nj}, aiPlayer);
+                                if (history.wouldRepeat(next.hash(opponent))) {
+                                    if (!hasFallback) {
+                                        fallback = {i, j, ni, nj};
+                                        hasFallback = true;
+                                    }
+                                    continue;
+                                }
                                 board.makeMove({i, j, ni, nj}, aiPlayer);
                                 moveMade = true;
                                 break;
@@ -255,6 +394,9 @@ void aiMove(Board& board, char aiPlayer) {
                 }
             }
         }
+        if (!moveMade && hasFallback) {
+            board.makeMove(fallback, aiPlayer); // Другого хода нет
+        }
     }
 
     std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Имитируем задержку для AI
@@ -270,11 +412,29 @@ int main() {
     std::cin >> playerColor;
     std::cin.ignore();
 
+    // Первыми ходят белые
+    GameHistory history;
+    history.reset(board.hash(WHITE));
+
+    auto isDraw = [&history]() {
+        if (history.isThreefoldRepetition()) {
+            std::cout << "Позиция повторилась трижды. Ничья.\n";
+            return true;
+        }
+        if (history.isNoProgressLimit()) {
+            std::cout << "40 ходов без рубок и ходов простыми шашками. Ничья.\n";
+            return true;
+        }
+        return false;
+    };
+
     if (playerColor == WHITE) {
         aiColor = BLACK;
     } else {
         aiColor = WHITE;
-        aiMove(board, aiColor);
+        Board before = board;
+        aiMove(board, aiColor, history);
+        history.push(board.hash(playerColor), isIrreversibleChange(before, board));
         board.display();
     }
 
@@ -285,14 +445,23 @@ int main() {
             std::cout << "У вас нет возможных ходов. Игра завершена.\n";
             break;
         }
+        Board before = board;
         playerMove(board, playerColor);
+        history.push(board.hash(aiColor), isIrreversibleChange(before, board));
         board.display();
+        if (isDraw()) break;
 
         if (!board.hasPossibleMoves(aiColor)) {
             std::cout << "У AI нет возможных ходов. Игра завершена.\n";
             break;
         }
-        aiMove(board, aiColor);
+        before = board;
+        aiMove(board, aiColor, history);
+        history.push(board.hash(playerColor), isIrreversibleChange(before, board));
+        if (isDraw()) {
+            board.display();
+            break;
+        }
     }
 
     return 0;